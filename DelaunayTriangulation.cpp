@@ -1,5 +1,7 @@
 #include "DelaunayTriangulation.h"
 #include <algorithm>
+#include <map>
+#include <thread>
 #include "Helpers.h"
 
 bool x_first(const float2& p1, const float2& p2)
@@ -11,6 +13,40 @@ bool y_first(const float2& p1, const float2& p2)
     return p1.y > p2.y || (p1.y == p2.y && p1.x > p2.x);
 }
 
+// Value reached by TriangulationProgress::mergedPoints once Triangulate completes on n points: every sub triangulation counts its points when it is complete
+// Sub triangulations of a same level only have two different sizes, so the counts are memoized by size
+uint64_t MergedPointsCount(uint64_t n, std::map<uint64_t, uint64_t>& counts)
+{
+    if (n <= 3)
+    {
+        return n;
+    }
+    auto it = counts.find(n);
+    if (it != counts.end())
+    {
+        return it->second;
+    }
+    uint64_t middle = (n + 1) / 2;
+    uint64_t count = n + MergedPointsCount(middle, counts) + MergedPointsCount(n - middle, counts);
+    counts[n] = count;
+    return count;
+}
+
+// Walks a whole turn of the convex hull from start, using next to step from one hull edge to the following one
+// Returns the hull edge whose origin comes first according to comparator, or last if last is true
+QuadEdge* FindHullEdge(QuadEdge* start, QuadEdge* (*next)(QuadEdge*), bool (*comparator)(const float2&, const float2&), bool last)
+{
+    QuadEdge* best = start;
+    for (QuadEdge* e = next(start); e != start; e = next(e))
+    {
+        if (last ? comparator(best->m_org, e->m_org) : comparator(e->m_org, best->m_org))
+        {
+            best = e;
+        }
+    }
+    return best;
+}
+
 QuadEdge::QuadEdge(float2 org, float2 dest) : m_org(org), m_dest(dest), m_onext(nullptr), m_oprev(nullptr), m_sym(nullptr), m_data(false)
 {
 }
@@ -27,10 +63,26 @@ bool QuadEdge::RightOf(float2 p)
     return DelaunayTriangulation::CCW(p, m_dest, m_org);
 }
 
-QuadEdge* QuadEdge::MakeEdge(std::vector<QuadEdge*>& CurrentGraph, float2 org, float2 dest)
+QuadEdge* QuadEdge::MakeEdge(std::vector<QuadEdge*>& CurrentGraph, std::vector<QuadEdge*>& FreeEdges, float2 org, float2 dest)
 {
-    QuadEdge* e = new QuadEdge(org, dest);
-    QuadEdge* esym = new QuadEdge(dest, org);
+    QuadEdge* e;
+    QuadEdge* esym;
+
+    // Reuse a deleted edge if any, its slot in the list of edges is already taken so there is nothing to push
+    if (!FreeEdges.empty())
+    {
+        e = FreeEdges.back();
+        FreeEdges.pop_back();
+        esym = e->m_sym;
+        *e = QuadEdge(org, dest);
+        *esym = QuadEdge(dest, org);
+    }
+    else
+    {
+        e = new QuadEdge(org, dest);
+        esym = new QuadEdge(dest, org);
+        CurrentGraph.push_back(e);
+    }
 
     e->m_sym = esym;
     esym->m_sym = e;
@@ -40,26 +92,28 @@ QuadEdge* QuadEdge::MakeEdge(std::vector<QuadEdge*>& CurrentGraph, float2 org, f
 
     esym->m_onext = esym;
     esym->m_oprev = esym;
-    CurrentGraph.push_back(e);
     return e;
 }
 
-QuadEdge* QuadEdge::Connect(std::vector<QuadEdge*>& CurrentGraph, QuadEdge* a, QuadEdge* b)
+QuadEdge* QuadEdge::Connect(std::vector<QuadEdge*>& CurrentGraph, std::vector<QuadEdge*>& FreeEdges, QuadEdge* a, QuadEdge* b)
 {
-    QuadEdge* e = MakeEdge(CurrentGraph, a->m_dest, b->m_org);
+    QuadEdge* e = MakeEdge(CurrentGraph, FreeEdges, a->m_dest, b->m_org);
     Splice(e, a->m_sym->m_oprev);
     Splice(e->m_sym, b);
     return e;
 }
 
-void QuadEdge::DeleteEdge(QuadEdge* e)
+void QuadEdge::DeleteEdge(std::vector<QuadEdge*>& FreeEdges, QuadEdge* e)
 {
     Splice(e, e->m_oprev);
     Splice(e->m_sym, e->m_sym->m_oprev);
 
     // Above splice is "logically" deleting the edge by moving pointers around, but they remain in the list of edges of the graph, so we mark them to remove later
+    // The graph no longer links to e, so it can be handed to the next MakeEdge. Either e or its sym is in the list of edges, reuse reinitializes both so it does not matter which one is pushed
+    // The caller is responsible for not keeping e around, Triangulate re-derives its extremities when the merge deletes one of them
     e->m_data = true;
     e->m_sym->m_data = true;
+    FreeEdges.push_back(e);
 }
 
 void QuadEdge::Splice(QuadEdge* a, QuadEdge* b)
@@ -110,6 +164,18 @@ std::pair<QuadEdge*, QuadEdge*> DelaunayTriangulation::Triangulate(std::vector<f
 {
     std::pair <QuadEdge*, QuadEdge*> extremities;
 
+    // Recursion boundary: a cancelled or expired triangulation returns null extremities all the way up without building anything else
+    if (ShouldStop())
+    {
+        return extremities;
+    }
+
+    // Both base cases below complete a sub triangulation
+    if (progress != nullptr && end - start <= 3)
+    {
+        progress->mergedPoints.fetch_add(end - start, std::memory_order_relaxed);
+    }
+
     // Base case where split left 2 vertices together, we form an edge out of them
     if (end - start == 2)
     {
@@ -121,7 +187,7 @@ std::pair<QuadEdge*, QuadEdge*> DelaunayTriangulation::Triangulate(std::vector<f
         {
             std::sort(orderedPoints.begin() + start, orderedPoints.begin() + end, y_first);
         }
-        QuadEdge* e = QuadEdge::MakeEdge(edges, orderedPoints[start], orderedPoints[end - 1]);
+        QuadEdge* e = QuadEdge::MakeEdge(edges, freeEdges, orderedPoints[start], orderedPoints[end - 1]);
         extremities.first = e;
         extremities.second = e->m_sym;
         return extremities;
@@ -142,15 +208,15 @@ std::pair<QuadEdge*, QuadEdge*> DelaunayTriangulation::Triangulate(std::vector<f
         p1 = orderedPoints[start];
         p2 = orderedPoints[start + 1];
         p3 = orderedPoints[end - 1];
-        QuadEdge* a = QuadEdge::MakeEdge(edges, p1, p2);
-        QuadEdge* b = QuadEdge::MakeEdge(edges, p2, p3);
+        QuadEdge* a = QuadEdge::MakeEdge(edges, freeEdges, p1, p2);
+        QuadEdge* b = QuadEdge::MakeEdge(edges, freeEdges, p2, p3);
         QuadEdge::Splice(a->m_sym, b);
 
         // Closing the triangle
         // Case where p3 is on the right side of p1p2
         if (CCW(p1, p2, p3))
         {
-            QuadEdge::Connect(edges, b, a);
+            QuadEdge::Connect(edges, freeEdges, b, a);
             extremities.first = a;
             extremities.second = b->m_sym;
             return extremities;
@@ -158,7 +224,7 @@ std::pair<QuadEdge*, QuadEdge*> DelaunayTriangulation::Triangulate(std::vector<f
         // Case where p3 os on the left side of p1p2
         if (CCW(p1, p3, p2))
         {
-            QuadEdge* c = QuadEdge::Connect(edges, b, a);
+            QuadEdge* c = QuadEdge::Connect(edges, freeEdges, b, a);
             extremities.first = c->m_sym;
             extremities.second = c;
             return extremities;
@@ -205,6 +271,13 @@ std::pair<QuadEdge*, QuadEdge*> DelaunayTriangulation::Triangulate(std::vector<f
         leftHalf = Triangulate(orderedPoints, start, start + middle, true, false);
         rightHalf = Triangulate(orderedPoints, start + middle, end, true, false);
     }
+
+    // Merge boundary: give up before stitching if either half was interrupted or if the run got interrupted meanwhile
+    if (ShouldStop())
+    {
+        return extremities;
+    }
+
     ldo = leftHalf.first;
     ldi = leftHalf.second;
     rdi = rightHalf.first;
@@ -273,7 +346,7 @@ std::pair<QuadEdge*, QuadEdge*> DelaunayTriangulation::Triangulate(std::vector<f
     }
 
     // Connects the cross edge between left and right part
-    QuadEdge* basel = QuadEdge::Connect(edges, rdi->m_sym, ldi);
+    QuadEdge* basel = QuadEdge::Connect(edges, freeEdges, rdi->m_sym, ldi);
     if (ldi->m_org == ldo->m_org)
     {
         ldo = basel->m_sym;
@@ -283,6 +356,9 @@ std::pair<QuadEdge*, QuadEdge*> DelaunayTriangulation::Triangulate(std::vector<f
         rdo = basel;
     }
 
+    // On near degenerate input the stitching may delete ldo or rdo, possibly along with the last edge of their origin. A deleted edge is recycled right away, so it must not be returned
+    bool ldoDeleted = false;
+    bool rdoDeleted = false;
 
     // Merge two parts by "stitching" them from bottom to top, deleting edges that become illegal in the process
     // The variable basel is the line that is perpendicular to y, and goes up to stitch the two parts together. We also need to keep its "right side" towards the top during the process, 
@@ -301,7 +377,9 @@ std::pair<QuadEdge*, QuadEdge*> DelaunayTriangulation::Triangulate(std::vector<f
             while (InCircle(basel->m_dest, basel->m_org, lcand->m_dest, lcand->m_onext->m_dest))
             {
                 QuadEdge* temp = lcand->m_onext;
-                QuadEdge::DeleteEdge(lcand);
+                ldoDeleted |= lcand == ldo || lcand->m_sym == ldo;
+                rdoDeleted |= lcand == rdo || lcand->m_sym == rdo;
+                QuadEdge::DeleteEdge(freeEdges, lcand);
                 lcand = temp;
             }
         }
@@ -312,7 +390,9 @@ std::pair<QuadEdge*, QuadEdge*> DelaunayTriangulation::Triangulate(std::vector<f
             while (InCircle(basel->m_dest, basel->m_org, rcand->m_dest, rcand->m_oprev->m_dest))
             {
                 QuadEdge* temp = rcand->m_oprev;
-                QuadEdge::DeleteEdge(rcand);
+                ldoDeleted |= rcand == ldo || rcand->m_sym == ldo;
+                rdoDeleted |= rcand == rdo || rcand->m_sym == rdo;
+                QuadEdge::DeleteEdge(freeEdges, rcand);
                 rcand = temp;
             }
         }
@@ -333,29 +413,93 @@ std::pair<QuadEdge*, QuadEdge*> DelaunayTriangulation::Triangulate(std::vector<f
             || (vRcand
                 && InCircle(lcand->m_dest, lcand->m_org, rcand->m_org, rcand->m_dest)))
         {
-            basel = QuadEdge::Connect(edges, rcand, basel->m_sym);
+            basel = QuadEdge::Connect(edges, freeEdges, rcand, basel->m_sym);
         }
         // Otherwise left side is best candidate, so we connect it to basel
         else
         {
-            basel = QuadEdge::Connect(edges, basel->m_sym, lcand->m_sym);
+            basel = QuadEdge::Connect(edges, freeEdges, basel->m_sym, lcand->m_sym);
         }
     }
 
+    // basel is now the upper tangent, oriented from right to left. A deleted extremity is replaced by the hull edge leaving the extreme point of the merged hull,
+    // walking the hull counterclockwise from basel for the left one and clockwise from its sym for the right one
+    if (ldoDeleted)
+    {
+        ldo = FindHullEdge(basel, [](QuadEdge* e) { return e->m_sym->m_onext; }, comparator, false);
+    }
+    if (rdoDeleted)
+    {
+        rdo = FindHullEdge(basel->m_sym, [](QuadEdge* e) { return e->m_sym->m_oprev; }, comparator, true);
+    }
+
+    if (progress != nullptr)
+    {
+        progress->mergedPoints.fetch_add(end - start, std::memory_order_relaxed);
+    }
+
     extremities.first = ldo;
     extremities.second = rdo;
     return extremities;
 }
 
-void DelaunayTriangulation::TriangulatePoints(std::vector<float2>& points, std::vector<Edge>& edgesResult)
+void DelaunayTriangulation::CompactEdges()
+{
+    // Every edge still marked as deleted is in the free list, so once they are freed the free list must be emptied as well
+    uint64_t kept = 0;
+    for (QuadEdge* quadEdge : edges)
+    {
+        if (quadEdge->m_data)
+        {
+            delete quadEdge->m_sym;
+            delete quadEdge;
+            continue;
+        }
+        edges[kept++] = quadEdge;
+    }
+    edges.resize(kept);
+    edges.shrink_to_fit();
+    freeEdges.clear();
+    freeEdges.shrink_to_fit();
+}
+
+void DelaunayTriangulation::TriangulatePoints(std::vector<float2>& points, std::vector<Edge>& edgesResult, bool compactEdges)
 {
+    status = TriangulationStatus::Completed;
+
+    // The sort below cannot be interrupted, so a run already cancelled or past its deadline stops before it
+    if (ShouldStop())
+    {
+        return;
+    }
+
     // Sort points by coordinates and remove duplicates
     InitData(points);
 
+    if (progress != nullptr)
+    {
+        std::map<uint64_t, uint64_t> counts;
+        progress->totalMergedPoints = MergedPointsCount(points.size(), counts);
+        progress->totalPoints = points.size();
+    }
+
     // Computes Delaunay's triangulation, Dwyer's variation is alternating horizontal and vertical split, this allows less triangles deletion when stitching, but we also need to implement horizontal merge
     Triangulate(points, 0, points.size(), true, true);
 
+    // Interrupted run, the partially built graph is useless. Only asynchronous runs can be interrupted, their triangulation is destroyed once the status is published
+    if (status != TriangulationStatus::Completed)
+    {
+        return;
+    }
+
+    // Deleted edges are reused during the merges, so only the few left in the free list remain to be discarded
+    if (compactEdges)
+    {
+        CompactEdges();
+    }
+
     // Remove trash edges generated during triangulation and convert to lighter structure
+    edgesResult.reserve(edgesResult.size() + edges.size() - freeEdges.size());
     for (QuadEdge* quadEdge : edges)
     {
         if (quadEdge->m_data)
@@ -366,17 +510,91 @@ void DelaunayTriangulation::TriangulatePoints(std::vector<float2>& points, std::
     }
 }
 
-DelaunayTriangulation::~DelaunayTriangulation()
+std::future<TriangulationResult> DelaunayTriangulation::TriangulatePointsAsync(std::vector<float2> points, std::shared_ptr<TriangulationProgress> progress,
+    std::chrono::steady_clock::time_point deadline, bool compactEdges)
+{
+    // Reset on the caller's thread, so the previous run's numbers are not reported during the initial sort and a cancellation requested once this call returned is not lost
+    progress->mergedPoints = 0;
+    progress->totalMergedPoints = 0;
+    progress->totalPoints = 0;
+    progress->cancelRequested = false;
+
+    std::promise<TriangulationResult> promise;
+    std::future<TriangulationResult> future = promise.get_future();
+
+    // The worker owns everything it touches, so it is detached and the caller may drop the future at any time, e.g right after requesting cancellation
+    std::thread([points = std::move(points), progress, deadline, compactEdges, promise = std::move(promise)]() mutable
+    {
+        // Destroyed when the worker ends, so the graph is freed after the result is published and its deallocation does not delay it
+        DelaunayTriangulation triangulation;
+        triangulation.progress = progress.get();
+        triangulation.deadline = deadline;
+
+        TriangulationResult result;
+        std::exception_ptr error;
+        try
+        {
+            triangulation.TriangulatePoints(points, result.edges, compactEdges);
+            result.status = triangulation.status;
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+
+        if (error)
+        {
+            promise.set_exception(error);
+        }
+        else
+        {
+            promise.set_value(std::move(result));
+        }
+    }).detach();
+
+    return future;
+}
+
+bool DelaunayTriangulation::ShouldStop()
+{
+    if (status != TriangulationStatus::Completed)
+    {
+        return true;
+    }
+    if (progress == nullptr)
+    {
+        return false;
+    }
+    if (progress->cancelRequested.load(std::memory_order_relaxed))
+    {
+        status = TriangulationStatus::Cancelled;
+        return true;
+    }
+    if (std::chrono::steady_clock::now() >= deadline)
+    {
+        status = TriangulationStatus::DeadlineExceeded;
+        return true;
+    }
+    return false;
+}
+
+void DelaunayTriangulation::ReleaseEdges(std::vector<QuadEdge*>& edgesToRelease)
 {
     // Delete allocated memory for edges of the graph
-    for (QuadEdge* QuadEdge : edges)
+    for (QuadEdge* QuadEdge : edgesToRelease)
     {
-        if (nullptr == QuadEdge->m_sym)
+        if (nullptr != QuadEdge->m_sym)
         {
             delete QuadEdge->m_sym;
         }
         delete QuadEdge;
     }
+    edgesToRelease.clear();
+}
+
+DelaunayTriangulation::~DelaunayTriangulation()
+{
+    ReleaseEdges(edges);
 }
 
 double QuadEdge::Length()
@@ -1,9 +1,50 @@
 #ifndef DELAUNAY_TRIANGULATION_H
 #define DELAUNAY_TRIANGULATION_H
 
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+
 class QuadEdge;
 struct Edge;
 
+// Outcome of a triangulation run
+enum class TriangulationStatus
+{
+    Completed,
+    Cancelled,
+    DeadlineExceeded
+};
+
+/*
+ State shared between an asynchronous triangulation and its caller. The caller polls the progress and can request cancellation at any time,
+ the triangulation checks for it at recursion and merge boundaries. TriangulatePointsAsync resets every field, so the same object can be reused for several runs
+ It is held through a shared_ptr so that it stays alive as long as the worker runs, even once the caller dropped the future
+*/
+struct TriangulationProgress
+{
+    // Number of points merged so far, summed over every level of the recursion: a point counts once for each sub triangulation containing it that is complete
+    // The progress ratio is mergedPoints / totalMergedPoints, it reaches 1 once the top level merge is done and only the conversion of the edges to the result remains
+    std::atomic<uint64_t> mergedPoints{ 0 };
+
+    // Value of mergedPoints once the triangulation completes, 0 until duplicates have been removed
+    std::atomic<uint64_t> totalMergedPoints{ 0 };
+
+    // Number of points to triangulate, 0 until duplicates have been removed
+    std::atomic<uint64_t> totalPoints{ 0 };
+
+    // Set by the caller to abort the triangulation
+    std::atomic<bool> cancelRequested{ false };
+};
+
+// Result of an asynchronous triangulation, edges is empty unless status is Completed
+struct TriangulationResult
+{
+    TriangulationStatus status = TriangulationStatus::Completed;
+    std::vector<Edge> edges;
+};
+
 /*
  class implementing the Guibas and Stolfi's divide and conquer algorithm to compute the delaunay triangulation of a set of point
 */
@@ -14,9 +55,24 @@ public:
     /*
      * @brief Run the whole triangulation process with data initialization before triangulation and trash filtering after
      * @param points The set of points to triangulate
+     * @param compactEdges If true, edges still waiting for reuse once the triangulation is complete are freed and removed from the edge list
      * @return The list of edges of the triangulation
      */
-    void TriangulatePoints(std::vector<float2>& points, std::vector<Edge>& edgesResults);
+    void TriangulatePoints(std::vector<float2>& points, std::vector<Edge>& edgesResults, bool compactEdges = false);
+
+    /*
+     * @brief Triangulates points with a triangulation of its own on a detached worker thread, reporting progress and stopping early on cancellation or once the deadline is reached.
+     * The worker owns all of its state: dropping the returned future neither waits for nor stops it, set cancelRequested to stop it.
+     * The graph is freed on the worker after the future is ready, so its deallocation does not delay the result.
+     * Cancellation and deadline are checked before the initial sort of the points, which is not interruptible, then at every recursion and merge boundary.
+     * A stop requested during the sort is thus only honoured once it is done.
+     * @param points The set of points to triangulate, move it in to avoid a copy
+     * @param progress Progress of the triangulation and cancellation flag, shared with the caller
+     * @param deadline Point in time after which the triangulation gives up
+     * @return Future holding the edges of the triangulation and whether it completed, was cancelled or exceeded its deadline
+     */
+    static std::future<TriangulationResult> TriangulatePointsAsync(std::vector<float2> points, std::shared_ptr<TriangulationProgress> progress,
+        std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max(), bool compactEdges = false);
 
     ~DelaunayTriangulation();
 
@@ -49,8 +105,29 @@ private:
     //          d.x  d.y  d.x²+d.y² 1 
     bool InCircle(float2 a, float2 b, float2 c, float2 d);
 
+    // Returns true if the triangulation must stop, i.e cancellation was requested or the deadline is reached. Stays true once it happened
+    bool ShouldStop();
+
+    // Frees every edge of the list, whether it is deleted or not, and empties it
+    static void ReleaseEdges(std::vector<QuadEdge*>& edgesToRelease);
+
+    // Frees the deleted edges that were not reused during the triangulation and removes them from the edge list, in place
+    void CompactEdges();
+
     // List of Quadedges forming the triangulation
     std::vector<QuadEdge*> edges;
+
+    // Edges deleted during merge, waiting to be reused by MakeEdge. They are still owned by the edges list
+    std::vector<QuadEdge*> freeEdges;
+
+    // Progress and cancellation state of the current asynchronous run, nullptr for a blocking run
+    TriangulationProgress* progress = nullptr;
+
+    // Deadline of the current asynchronous run
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+
+    // Outcome of the current run, set when ShouldStop first detects a cancellation or an expired deadline
+    TriangulationStatus status = TriangulationStatus::Completed;
 };
 
 
@@ -74,15 +151,17 @@ public:
     bool RightOf(float2 p);
 
     /*
-     * @brief Creates an edge linking points org and dest, adding it to the list of edges
+     * @brief Creates an edge linking points org and dest. A previously deleted edge is reused if available, otherwise a new one is allocated and added to the list of edges
      * @param CurrentGraph The list of edges defining the Delaunay triangulation
+     * @param FreeEdges The list of deleted edges available for reuse
      */
-    static QuadEdge* MakeEdge(std::vector<QuadEdge*>& CurrentGraph, float2 org, float2 dest);
+    static QuadEdge* MakeEdge(std::vector<QuadEdge*>& CurrentGraph, std::vector<QuadEdge*>& FreeEdges, float2 org, float2 dest);
 
     // Connects points a and b by creating an edge between them
-    static QuadEdge* Connect(std::vector<QuadEdge*>& CurrentGraph, QuadEdge* a, QuadEdge* b);
+    static QuadEdge* Connect(std::vector<QuadEdge*>& CurrentGraph, std::vector<QuadEdge*>& FreeEdges, QuadEdge* a, QuadEdge* b);
 
-    static void DeleteEdge(QuadEdge* e);
+    // Detaches e from the graph and hands it over to FreeEdges so the next MakeEdge can reuse it
+    static void DeleteEdge(std::vector<QuadEdge*>& FreeEdges, QuadEdge* e);
 
     static void Splice(QuadEdge* a, QuadEdge* b);
 
@@ -93,7 +172,7 @@ public:
     QuadEdge* m_onext;
     QuadEdge* m_oprev;
     QuadEdge* m_sym;
-    bool m_data; // Used to discard deleted edges once the triangulation is complete, avoid having to seek the edge to remove in our array every call of delete edge
+    bool m_data; // Marks deleted edges that were not reused yet, so they can be discarded once the triangulation is complete without seeking them in our array every call of delete edge
 };
 
 #endif // DELAUNAY_TRIANGULATION_H
\ No newline at end of file